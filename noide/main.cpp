@@ -1,18 +1,53 @@
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QGLWidget>
 #include <QGLFunctions>
+#include <QOpenGLContext>
 #include <QOpenGLShaderProgram>
 
 #include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A microbenchmark of ways to get per-object data for N objects to the GPU
+// every frame. It is meant to inform how the video player should submit
+// its overlays and mosaic tiles. Every object is the same triangle at its
+// own (animated) offset and scale; what differs is how that gets there:
+//
+// - ClientArrays: one draw per object, vertices re-sent from client memory
+//   each time (what this program originally did).
+// - StaticVBO: the triangle lives in a VBO; one draw per object with the
+//   per-object data set as a constant vertex attribute.
+// - Instanced: one instanced draw; the per-object data is re-uploaded into
+//   an orphaned buffer every frame.
+// - PersistentRing: one instanced draw; the per-object data is written
+//   straight into a persistently mapped ring buffer, fenced per section.
+//
+// Rendering runs with vsync off, back to back, so the frame time reflects
+// the cost of submission rather than the refresh rate. For each strategy
+// and object count it prints the CPU time spent submitting, the GPU time
+// (from GL_TIME_ELAPSED queries, where available) and the frame time.
+//
+// Usage: noide [object-count...]
 
 const char VertexShaderSource[] = R"(
 attribute highp vec4 posAttr;
 attribute lowp vec4 colAttr;
+attribute highp vec3 instanceAttr;
 varying lowp vec4 col;
 uniform highp mat4 matrix;
 void main() {
    col = colAttr;
-   gl_Position = matrix * posAttr;
+   vec4 P = vec4(posAttr.xy * instanceAttr.z + instanceAttr.xy, 0.0, 1.0);
+   gl_Position = matrix * P;
 }
 )";
 const char FragmentShaderSource[] = R"(
@@ -22,14 +57,72 @@ void main() {
 }
 )";
 
+template <typename T>
+T *typedNullptr() {
+  return static_cast<T *>(nullptr);
+}
+
+template <typename MemberTy, typename StructTy>
+GLvoid *offsetOfAsPtr(MemberTy StructTy::*MemberPtr) {
+  return std::addressof(typedNullptr<StructTy>()->*MemberPtr);
+}
+
+struct Vertex {
+  GLfloat XY[2];
+  GLfloat RGB[3];
+};
+
+// Per-object data: offset in XY, uniform scale in Z.
+struct Instance {
+  GLfloat XYScale[3];
+};
+
+const Vertex TriangleVertices[] = {     //
+    {{0.0f, 0.707f}, {1.0f, 0.0f, 0.0f}}, //
+    {{-0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}}, //
+    {{0.5f, -0.5f}, {0.0f, 0.0f, 1.0f}},  //
+};
+
+enum Strategy {
+  ClientArrays,
+  StaticVBO,
+  Instanced,
+  PersistentRing,
+  NumStrategies
+};
+
+const char *const StrategyNames[] = {"client-arrays", "static-vbo", "instanced",
+                                     "persistent-ring"};
+
+// Frames thrown away while the driver settles, and frames measured.
+static const int WarmupFrames = 30;
+static const int MeasuredFrames = 300;
+
+// Sections in the persistently mapped ring, i.e. how many frames the CPU
+// may run ahead of the GPU before it has to wait on a fence.
+static const int RingSections = 3;
+
+// GPU timer queries are read back this many frames late so that reading
+// them never stalls the pipeline.
+static const int QueryLatency = 4;
+
 class MyGLWidget : public QGLWidget, protected QGLFunctions {
   Q_OBJECT
 
 public:
-  MyGLWidget() {
-    QTimer *T = new QTimer();
-    T->start(10);
-    connect(T, SIGNAL(timeout()), this, SLOT(repaint()));
+  MyGLWidget(const QGLFormat &Format, std::vector<int> ObjectCounts_)
+      : QGLWidget(Format), ObjectCounts(std::move(ObjectCounts_)) {
+    // A zero-interval timer renders the next frame as soon as the event
+    // loop is idle; with vsync off, swapping doesn't throttle us either.
+    QTimer *T = new QTimer(this);
+    connect(T, SIGNAL(timeout()), this, SLOT(updateGL()));
+    T->start(0);
+  }
+  ~MyGLWidget() {
+    makeCurrent();
+    if (HasTimerQueries)
+      DeleteQueries(QueryLatency, Queries);
+    glDeleteBuffers(1, &TriangleVBO);
   }
 
 protected:
@@ -39,65 +132,431 @@ protected:
     Program->addShaderFromSourceCode(QOpenGLShader::Vertex, VertexShaderSource);
     Program->addShaderFromSourceCode(QOpenGLShader::Fragment,
                                      FragmentShaderSource);
+    // instanceAttr is a constant attribute in the non-instanced strategies.
+    // In a compatibility context generic attribute 0 aliases the vertex
+    // position and has no reliable current value, so keep it for posAttr.
+    Program->bindAttributeLocation("posAttr", 0);
     Program->link();
     PosAttr = Program->attributeLocation("posAttr");
     ColAttr = Program->attributeLocation("colAttr");
+    InstanceAttr = Program->attributeLocation("instanceAttr");
     MatrixUniform = Program->uniformLocation("matrix");
+
+    // None of these are in OpenGL ES 2.0, so QGLFunctions doesn't have
+    // them. A function pointer coming back doesn't mean the context can
+    // use it, so each feature is first checked against the context version
+    // and extensions. Strategies that need a missing one get skipped.
+    // Before 3.3, instancing comes from the ARB extensions, whose entry
+    // points carry the suffix.
+    bool CoreInstancing = hasFeature(3, 3, {});
+    HasInstancing =
+        hasFeature(3, 3,
+                   {"GL_ARB_instanced_arrays", "GL_ARB_draw_instanced"}) &&
+        resolve(DrawArraysInstanced, CoreInstancing
+                                         ? "glDrawArraysInstanced"
+                                         : "glDrawArraysInstancedARB") &&
+        resolve(VertexAttribDivisor, CoreInstancing
+                                         ? "glVertexAttribDivisor"
+                                         : "glVertexAttribDivisorARB");
+    HasPersistentMapping =
+        hasFeature(4, 4, {"GL_ARB_buffer_storage"}) &&
+        hasFeature(3, 0, {"GL_ARB_map_buffer_range"}) &&
+        hasFeature(3, 2, {"GL_ARB_sync"}) &&
+        resolve(BufferStorage, "glBufferStorage") &&
+        resolve(MapBufferRange, "glMapBufferRange") &&
+        resolve(UnmapBuffer, "glUnmapBuffer") &&
+        resolve(FenceSync, "glFenceSync") &&
+        resolve(ClientWaitSync, "glClientWaitSync") &&
+        resolve(DeleteSync, "glDeleteSync");
+    HasTimerQueries = hasFeature(3, 3, {"GL_ARB_timer_query"}) &&
+                      resolve(GenQueries, "glGenQueries") &&
+                      resolve(DeleteQueries, "glDeleteQueries") &&
+                      resolve(BeginQuery, "glBeginQuery") &&
+                      resolve(EndQuery, "glEndQuery") &&
+                      resolve(GetQueryObjectiv, "glGetQueryObjectiv") &&
+                      resolve(GetQueryObjectui64v, "glGetQueryObjectui64v");
+    if (HasTimerQueries)
+      GenQueries(QueryLatency, Queries);
+
+    glGenBuffers(1, &TriangleVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, TriangleVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(TriangleVertices), TriangleVertices,
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::printf("%-16s %8s %12s %12s %12s %12s\n", "strategy", "objects",
+                "cpu-ms", "gpu-ms", "frame-p50", "frame-p99");
+    startRun();
   }
+
   void paintGL() override {
+    if (Done)
+      return;
+    qint64 FrameStart = Clock.nsecsElapsed();
+    if (LastFrameStart >= 0 && FrameInRun > WarmupFrames)
+      FrameNs.push_back(FrameStart - LastFrameStart);
+    LastFrameStart = FrameStart;
+
+    animate();
+
     glClearColor(0.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    Program->bind();
+    bool Measure = FrameInRun >= WarmupFrames;
+    GLuint Query = Queries[FrameInRun % QueryLatency];
+    if (HasTimerQueries && Measure) {
+      collectQuery(Query);
+      BeginQuery(GL_TIME_ELAPSED, Query);
+    }
 
+    qint64 SubmitStart = Clock.nsecsElapsed();
+    Program->bind();
     QMatrix4x4 M;
-    M.perspective(60, 4.0 / 3.0, 0.1, 100.0);
+    M.perspective(60, static_cast<qreal>(width()) / height(), 0.1, 100.0);
     M.translate(0, 0, -2);
-    // M.rotate(100.0f * FrameNum / screen()->refreshRate(), 0, 1, 0);
-    M.rotate(100.0f * FrameNum / 60, 0, 1, 0);
-
+    M.rotate(100.0f * TotalFrames / 60, 0, 1, 0);
     Program->setUniformValue(MatrixUniform, M);
+    submit();
+    Program->release();
+    if (Measure)
+      CpuNs.push_back(Clock.nsecsElapsed() - SubmitStart);
 
-    GLfloat Vertices[] = { //
-      0.0f, 0.707f,        //
-      -0.5f, -0.5f,        //
-      0.5f, -0.5f          //
-    };
-    GLfloat Colors[] = { //
-      1.0f, 0.0f, 0.0f,  //
-      0.0f, 1.0f, 0.0f,  //
-      0.0f, 0.0f, 1.0f   //
-    };
+    if (HasTimerQueries && Measure) {
+      EndQuery(GL_TIME_ELAPSED);
+      QueryPending[FrameInRun % QueryLatency] = true;
+    }
+
+    ++TotalFrames;
+    if (++FrameInRun == WarmupFrames + MeasuredFrames)
+      finishRun();
+  }
 
-    glVertexAttribPointer(PosAttr, 2, GL_FLOAT, GL_FALSE, 0, Vertices);
-    glVertexAttribPointer(ColAttr, 3, GL_FLOAT, GL_FALSE, 0, Colors);
+private:
+  template <typename FnTy>
+  bool resolve(FnTy &Fn, const char *Name) {
+    Fn = reinterpret_cast<FnTy>(
+        context()->getProcAddress(QLatin1String(Name)));
+    return Fn != nullptr;
+  }
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+  // Whether the context is desktop OpenGL `Major`.`Minor` or later, or
+  // failing that, has all of `Extensions`. An empty list means the
+  // version is required.
+  bool hasFeature(int Major, int Minor,
+                  std::initializer_list<const char *> Extensions) {
+    QOpenGLContext *Context = context()->contextHandle();
+    if (Context->isOpenGLES())
+      return false;
+    if (Context->format().version() >= qMakePair(Major, Minor))
+      return true;
+    if (Extensions.size() == 0)
+      return false;
+    for (const char *Extension : Extensions)
+      if (!Context->hasExtension(Extension))
+        return false;
+    return true;
+  }
 
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+  bool isSupported(Strategy S) {
+    switch (S) {
+    case ClientArrays:
+    case StaticVBO:
+      return true;
+    case Instanced:
+      return HasInstancing;
+    case PersistentRing:
+      return HasInstancing && HasPersistentMapping;
+    default:
+      return false;
+    }
+  }
 
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(0);
+  int objectCount() { return ObjectCounts[CountIndex]; }
 
-    Program->release();
-    ++FrameNum;
+  // Lays the objects out on a grid and wobbles each one a little, so that
+  // the per-object data really does change every frame.
+  void animate() {
+    int N = objectCount();
+    int Side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(N))));
+    GLfloat Cell = 2.0f / Side;
+    GLfloat T = TotalFrames / 60.0f;
+    for (int I = 0; I < N; ++I) {
+      GLfloat X = -1.0f + Cell * (I % Side + 0.5f);
+      GLfloat Y = -1.0f + Cell * (I / Side + 0.5f);
+      Instances[I].XYScale[0] = X + 0.1f * Cell * std::cos(T + I);
+      Instances[I].XYScale[1] = Y + 0.1f * Cell * std::sin(T + I);
+      Instances[I].XYScale[2] = 0.8f * Cell;
+    }
   }
-  void repaint() {
-    paintGL();
+
+  void bindTriangleVBO() {
+    glBindBuffer(GL_ARRAY_BUFFER, TriangleVBO);
+    glVertexAttribPointer(PosAttr, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          offsetOfAsPtr(&Vertex::XY));
+    glVertexAttribPointer(ColAttr, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          offsetOfAsPtr(&Vertex::RGB));
+    glEnableVertexAttribArray(PosAttr);
+    glEnableVertexAttribArray(ColAttr);
+  }
+
+  void submit() {
+    int N = objectCount();
+    switch (CurrentStrategy) {
+    case ClientArrays:
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      glEnableVertexAttribArray(PosAttr);
+      glEnableVertexAttribArray(ColAttr);
+      for (int I = 0; I < N; ++I) {
+        glVertexAttribPointer(PosAttr, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              &TriangleVertices[0].XY);
+        glVertexAttribPointer(ColAttr, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              &TriangleVertices[0].RGB);
+        glVertexAttrib3fv(InstanceAttr, Instances[I].XYScale);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+      }
+      glDisableVertexAttribArray(ColAttr);
+      glDisableVertexAttribArray(PosAttr);
+      break;
+
+    case StaticVBO:
+      bindTriangleVBO();
+      for (int I = 0; I < N; ++I) {
+        glVertexAttrib3fv(InstanceAttr, Instances[I].XYScale);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+      }
+      glDisableVertexAttribArray(ColAttr);
+      glDisableVertexAttribArray(PosAttr);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      break;
+
+    case Instanced:
+      bindTriangleVBO();
+      glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+      // Orphan last frame's storage so we don't wait for the GPU to be
+      // done reading it.
+      glBufferData(GL_ARRAY_BUFFER, N * sizeof(Instance), nullptr,
+                   GL_STREAM_DRAW);
+      glBufferSubData(GL_ARRAY_BUFFER, 0, N * sizeof(Instance),
+                      Instances.data());
+      drawInstanced(nullptr);
+      break;
+
+    case PersistentRing: {
+      int Section = TotalFrames % RingSections;
+      if (Fences[Section]) {
+        ClientWaitSync(Fences[Section], GL_SYNC_FLUSH_COMMANDS_BIT,
+                       GLuint64(-1));
+        DeleteSync(Fences[Section]);
+        Fences[Section] = nullptr;
+      }
+      std::memcpy(RingMapping + Section * N, Instances.data(),
+                  N * sizeof(Instance));
+      bindTriangleVBO();
+      glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+      drawInstanced(
+          reinterpret_cast<GLvoid *>(Section * N * sizeof(Instance)));
+      Fences[Section] = FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+
+  // Draws all objects from the instance data at `Offset` in the currently
+  // bound GL_ARRAY_BUFFER.
+  void drawInstanced(const GLvoid *Offset) {
+    glVertexAttribPointer(InstanceAttr, 3, GL_FLOAT, GL_FALSE,
+                          sizeof(Instance), Offset);
+    glEnableVertexAttribArray(InstanceAttr);
+    VertexAttribDivisor(InstanceAttr, 1);
+    DrawArraysInstanced(GL_TRIANGLES, 0, 3, objectCount());
+    VertexAttribDivisor(InstanceAttr, 0);
+    glDisableVertexAttribArray(InstanceAttr);
+    glDisableVertexAttribArray(ColAttr);
+    glDisableVertexAttribArray(PosAttr);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
   }
-  QOpenGLShaderProgram *Program;
+
+  // Adds the result of `Query` to the GPU times if it was issued and has
+  // finished. Called just before the query object gets reused.
+  void collectQuery(GLuint Query) {
+    int Slot = FrameInRun % QueryLatency;
+    if (!QueryPending[Slot])
+      return;
+    QueryPending[Slot] = false;
+    GLint Available = 0;
+    GetQueryObjectiv(Query, GL_QUERY_RESULT_AVAILABLE, &Available);
+    // After QueryLatency frames it normally is; waiting would skew the
+    // very frame times we're measuring, so just drop the sample.
+    if (!Available)
+      return;
+    GLuint64 Ns = 0;
+    GetQueryObjectui64v(Query, GL_QUERY_RESULT, &Ns);
+    GpuNs.push_back(static_cast<qint64>(Ns));
+  }
+
+  void startRun() {
+    while (!isSupported(CurrentStrategy)) {
+      std::printf("%-16s %8d %12s\n", StrategyNames[CurrentStrategy],
+                  objectCount(), "unsupported");
+      if (!advance())
+        return;
+    }
+    FrameInRun = 0;
+    LastFrameStart = -1;
+    CpuNs.clear();
+    GpuNs.clear();
+    FrameNs.clear();
+    std::fill(std::begin(QueryPending), std::end(QueryPending), false);
+    Instances.assign(objectCount(), Instance());
+
+    if (CurrentStrategy == Instanced) {
+      glGenBuffers(1, &InstanceVBO);
+    } else if (CurrentStrategy == PersistentRing) {
+      GLsizeiptr Size = RingSections * objectCount() * sizeof(Instance);
+      GLbitfield Flags =
+          GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glGenBuffers(1, &InstanceVBO);
+      glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+      BufferStorage(GL_ARRAY_BUFFER, Size, nullptr, Flags);
+      RingMapping = static_cast<Instance *>(
+          MapBufferRange(GL_ARRAY_BUFFER, 0, Size, Flags));
+      if (!RingMapping)
+        qFatal("Unable to map the instance ring buffer");
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    Clock.start();
+  }
+
+  void finishRun() {
+    glFinish();
+    report();
+
+    if (CurrentStrategy == PersistentRing) {
+      for (GLsync &Fence : Fences) {
+        if (Fence)
+          DeleteSync(Fence);
+        Fence = nullptr;
+      }
+      glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+      UnmapBuffer(GL_ARRAY_BUFFER);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      RingMapping = nullptr;
+    }
+    if (InstanceVBO) {
+      glDeleteBuffers(1, &InstanceVBO);
+      InstanceVBO = 0;
+    }
+
+    if (advance())
+      startRun();
+  }
+
+  // Moves on to the next strategy, and then to the next object count.
+  // Returns false (and quits) once everything has run.
+  bool advance() {
+    CurrentStrategy = static_cast<Strategy>(CurrentStrategy + 1);
+    if (CurrentStrategy == NumStrategies) {
+      CurrentStrategy = ClientArrays;
+      if (++CountIndex == static_cast<int>(ObjectCounts.size())) {
+        Done = true;
+        QTimer::singleShot(0, qApp, SLOT(quit()));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static double meanMs(const std::vector<qint64> &Ns) {
+    if (Ns.empty())
+      return 0;
+    double Sum = 0;
+    for (qint64 X : Ns)
+      Sum += X;
+    return Sum / Ns.size() / 1e6;
+  }
+
+  static double percentileMs(std::vector<qint64> Ns, double P) {
+    if (Ns.empty())
+      return 0;
+    size_t K = static_cast<size_t>(P * (Ns.size() - 1));
+    std::nth_element(Ns.begin(), Ns.begin() + K, Ns.end());
+    return Ns[K] / 1e6;
+  }
+
+  void report() {
+    char Gpu[32] = "n/a";
+    if (!GpuNs.empty())
+      std::snprintf(Gpu, sizeof(Gpu), "%.3f", meanMs(GpuNs));
+    std::printf("%-16s %8d %12.3f %12s %12.3f %12.3f\n",
+                StrategyNames[CurrentStrategy], objectCount(), meanMs(CpuNs),
+                Gpu, percentileMs(FrameNs, 0.5), percentileMs(FrameNs, 0.99));
+    std::fflush(stdout);
+  }
+
+  QOpenGLShaderProgram *Program = nullptr;
   GLuint PosAttr;
   GLuint ColAttr;
+  GLuint InstanceAttr;
   GLuint MatrixUniform;
-  int FrameNum = 0;
+  GLuint TriangleVBO = 0;
+  GLuint InstanceVBO = 0;
+
+  PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced = nullptr;
+  PFNGLVERTEXATTRIBDIVISORPROC VertexAttribDivisor = nullptr;
+  PFNGLBUFFERSTORAGEPROC BufferStorage = nullptr;
+  PFNGLMAPBUFFERRANGEPROC MapBufferRange = nullptr;
+  PFNGLUNMAPBUFFERPROC UnmapBuffer = nullptr;
+  PFNGLFENCESYNCPROC FenceSync = nullptr;
+  PFNGLCLIENTWAITSYNCPROC ClientWaitSync = nullptr;
+  PFNGLDELETESYNCPROC DeleteSync = nullptr;
+  PFNGLGENQUERIESPROC GenQueries = nullptr;
+  PFNGLDELETEQUERIESPROC DeleteQueries = nullptr;
+  PFNGLBEGINQUERYPROC BeginQuery = nullptr;
+  PFNGLENDQUERYPROC EndQuery = nullptr;
+  PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv = nullptr;
+  PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v = nullptr;
+  bool HasInstancing = false;
+  bool HasPersistentMapping = false;
+  bool HasTimerQueries = false;
+
+  Instance *RingMapping = nullptr;
+  GLsync Fences[RingSections] = {};
+  GLuint Queries[QueryLatency] = {};
+  bool QueryPending[QueryLatency] = {};
+
+  std::vector<int> ObjectCounts;
+  int CountIndex = 0;
+  Strategy CurrentStrategy = ClientArrays;
+  bool Done = false;
+  std::vector<Instance> Instances;
+
+  QElapsedTimer Clock;
+  qint64 LastFrameStart = -1;
+  int FrameInRun = 0;
+  int TotalFrames = 0;
+  std::vector<qint64> CpuNs;
+  std::vector<qint64> GpuNs;
+  std::vector<qint64> FrameNs;
 };
 // <http://www.qtcentre.org/threads/28580-Why-does-qmake-moc-only-process-header-files>
 #include "main.moc"
 
 int main(int argc, char *argv[]) {
   QApplication a(argc, argv);
-  MyGLWidget gl;
+
+  std::vector<int> ObjectCounts;
+  for (int I = 1; I < argc; ++I)
+    ObjectCounts.push_back(std::max(1, atoi(argv[I])));
+  if (ObjectCounts.empty())
+    ObjectCounts = {1, 100, 1000, 10000};
+
+  QGLFormat Format;
+  Format.setSwapInterval(0);
+  MyGLWidget gl(Format, ObjectCounts);
+  gl.resize(640, 480);
   gl.show();
 
   return a.exec();
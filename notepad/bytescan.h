@@ -0,0 +1,38 @@
+#ifndef BYTESCAN_H
+#define BYTESCAN_H
+
+#include <cstring>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+
+// Calls fn(p) for every p in [begin, end) with *p == c, in increasing order.
+// Stops early and returns false as soon as fn returns false. With SSE2 this
+// compares 16 bytes at a time and only walks the bits of the match mask, so
+// it runs at close to memory bandwidth when c is rare (newlines, or the
+// first byte of a search needle).
+template <typename Fn>
+bool forEachByte(const char *begin, const char *end, char c, Fn fn)
+{
+    const char *p = begin;
+#if defined(__SSE2__) && defined(__GNUC__)
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        while (mask) {
+            if (!fn(p + __builtin_ctz(mask)))
+                return false;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; p != end; ++p) {
+        if (*p == c && !fn(p))
+            return false;
+    }
+    return true;
+}
+
+#endif // BYTESCAN_H
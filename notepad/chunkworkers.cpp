@@ -0,0 +1,46 @@
+#include "chunkworkers.h"
+#include <QThread>
+#include <algorithm>
+
+ChunkWorkers::ChunkWorkers() :
+    count(0),
+    stopped(false),
+    next(0),
+    running(0)
+{
+}
+
+ChunkWorkers::~ChunkWorkers()
+{
+    stop();
+}
+
+void ChunkWorkers::start(qint64 newCount, std::function<void(qint64)> newJob, std::function<void()> newDone)
+{
+    stop();
+    count = newCount;
+    job = newJob;
+    done = newDone;
+    stopped = false;
+    next = 0;
+    int threadCount = static_cast<int>(std::max<qint64>(1, std::min<qint64>(QThread::idealThreadCount(), count)));
+    running = threadCount;
+    for (int i = 0; i < threadCount; ++i)
+        threads.push_back(std::thread(&ChunkWorkers::run, this));
+}
+
+void ChunkWorkers::stop()
+{
+    stopped = true;
+    for (std::thread &t : threads)
+        t.join();
+    threads.clear();
+}
+
+void ChunkWorkers::run()
+{
+    for (qint64 k = next++; k < count && !stopped; k = next++)
+        job(k);
+    if (--running == 0 && !stopped && done)
+        done();
+}
@@ -0,0 +1,48 @@
+#ifndef CHUNKWORKERS_H
+#define CHUNKWORKERS_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs a job over the fixed-size chunks of a buffer on all cores. The
+// threads pull chunk numbers from a shared counter, so chunks are started
+// in order and the load stays even however long each one takes. Used by
+// both LineIndex and TextSearch, which therefore agree on chunk bounds.
+class ChunkWorkers
+{
+public:
+    // Big enough to amortize the per-chunk bookkeeping, small enough that
+    // results for the start of a file show up quickly and the threads stay
+    // evenly loaded.
+    static const qint64 chunkSize = 16 << 20;
+
+    static qint64 chunkCount(qint64 size) { return (size + chunkSize - 1) / chunkSize; }
+
+    ChunkWorkers();
+    ~ChunkWorkers();
+
+    // Stops any previous run, then calls job(k) for every k in
+    // [0, chunkCount) on the worker threads and returns right away. The
+    // last thread to finish calls `done`, unless the run was stopped.
+    void start(qint64 chunkCount, std::function<void(qint64)> job, std::function<void()> done = nullptr);
+    // Blocks until the worker threads have stopped. Jobs should poll
+    // isStopped() to return early.
+    void stop();
+    bool isStopped() const { return stopped; }
+
+private:
+    void run();
+
+    qint64 count;
+    std::function<void(qint64)> job;
+    std::function<void()> done;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopped;
+    std::atomic<qint64> next;
+    std::atomic<int> running;
+};
+
+#endif // CHUNKWORKERS_H
@@ -0,0 +1,128 @@
+#include "fileworker.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QTextCodec>
+#include <QTextDecoder>
+
+// Small enough that inserting one chunk into the document doesn't stall
+// the GUI noticeably.
+static const qint64 readChunkSize = 256 << 10;
+
+FileWorker::FileWorker(QObject *parent) :
+    QObject(parent),
+    loadFile(0),
+    decoder(0),
+    saveFile(0),
+    pendingCarriageReturn(false)
+{
+}
+
+FileWorker::~FileWorker()
+{
+    delete decoder;
+    delete loadFile;
+    // Destroying an uncommitted QSaveFile discards it.
+    delete saveFile;
+}
+
+void FileWorker::startLoad(const QString &fileName)
+{
+    loadFile = new QFile(fileName);
+    if (!loadFile->open(QIODevice::ReadOnly)) {
+        finishLoad(false, loadFile->errorString());
+        return;
+    }
+    readChunk();
+}
+
+void FileWorker::readChunk()
+{
+    if (!loadFile)
+        return;
+    QByteArray bytes = loadFile->read(readChunkSize);
+    if (bytes.isEmpty()) {
+        if (loadFile->error() != QFileDevice::NoError) {
+            finishLoad(false, loadFile->errorString());
+            return;
+        }
+        if (pendingCarriageReturn)
+            emit chunkRead(QString(QLatin1Char('\r')));
+        finishLoad(true, QString());
+        return;
+    }
+    if (!decoder) {
+        // Same as QTextStream: honour a BOM, otherwise assume the locale's
+        // encoding.
+        QTextCodec *codec = QTextCodec::codecForUtfText(bytes, QTextCodec::codecForLocale());
+        decoder = codec->makeDecoder();
+    }
+    QString text = decoder->toUnicode(bytes);
+    if (pendingCarriageReturn)
+        text.prepend(QLatin1Char('\r'));
+    pendingCarriageReturn = text.endsWith(QLatin1Char('\r'));
+    if (pendingCarriageReturn)
+        text.chop(1);
+    emit loadProgress(loadFile->pos(), loadFile->size());
+    emit chunkRead(text);
+}
+
+void FileWorker::finishLoad(bool ok, const QString &errorString)
+{
+    delete decoder;
+    decoder = 0;
+    delete loadFile;
+    loadFile = 0;
+    pendingCarriageReturn = false;
+    emit loadFinished(ok, errorString);
+}
+
+void FileWorker::startSave(const QString &fileName)
+{
+    saveFile = new QSaveFile(fileName);
+    if (!saveFile->open(QIODevice::WriteOnly)) {
+        QString errorString = saveFile->errorString();
+        delete saveFile;
+        saveFile = 0;
+        emit saveFinished(false, errorString);
+        return;
+    }
+    emit chunkWritten();
+}
+
+void FileWorker::writeChunk(const QByteArray &bytes)
+{
+    if (!saveFile)
+        return;
+    if (saveFile->write(bytes) != bytes.size()) {
+        QString errorString = saveFile->errorString();
+        saveFile->cancelWriting();
+        delete saveFile;
+        saveFile = 0;
+        emit saveFinished(false, errorString);
+        return;
+    }
+    emit chunkWritten();
+}
+
+void FileWorker::finishSave()
+{
+    if (!saveFile)
+        return;
+    bool ok = saveFile->commit();
+    QString errorString = ok ? QString() : saveFile->errorString();
+    delete saveFile;
+    saveFile = 0;
+    emit saveFinished(ok, errorString);
+}
+
+void FileWorker::abort()
+{
+    if (loadFile)
+        finishLoad(false, tr("Cancelled"));
+    if (saveFile) {
+        saveFile->cancelWriting();
+        delete saveFile;
+        saveFile = 0;
+        emit saveFinished(false, tr("Cancelled"));
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef FILEWORKER_H
+#define FILEWORKER_H
+
+#include <QObject>
+#include <QString>
+
+class QFile;
+class QSaveFile;
+class QTextDecoder;
+
+// Does the file I/O for Notepad on a separate thread. Both directions are
+// driven by the GUI one chunk at a time: the worker only reads the next
+// chunk when asked to (readChunk) and signals chunkWritten when it is
+// ready for more, so at most one chunk is ever in flight and neither side
+// can run away from the other.
+class FileWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileWorker(QObject *parent = 0);
+    ~FileWorker();
+
+public slots:
+    // Loading. Emits chunkRead for the first chunk right away; every
+    // further chunk has to be requested with readChunk.
+    void startLoad(const QString &fileName);
+    void readChunk();
+
+    // Saving. Goes through QSaveFile, so the destination is only replaced
+    // once finishSave commits; an abort or error leaves it untouched.
+    void startSave(const QString &fileName);
+    void writeChunk(const QByteArray &bytes);
+    void finishSave();
+
+    // Drops whatever is in progress and emits the matching *Finished
+    // signal with ok == false.
+    void abort();
+
+signals:
+    void chunkRead(const QString &text);
+    void loadProgress(qint64 bytesRead, qint64 bytesTotal);
+    void loadFinished(bool ok, const QString &errorString);
+
+    void chunkWritten();
+    void saveFinished(bool ok, const QString &errorString);
+
+private:
+    void finishLoad(bool ok, const QString &errorString);
+
+    QFile *loadFile;
+    QTextDecoder *decoder;
+    QSaveFile *saveFile;
+    // A '\r' that ended the previous chunk. It is held back so that a
+    // "\r\n" split across chunks still reaches QTextCursor::insertText in
+    // one piece and becomes a single line break.
+    bool pendingCarriageReturn;
+};
+
+#endif // FILEWORKER_H
@@ -0,0 +1,287 @@
+#include "largefileview.h"
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextCodec>
+#include <algorithm>
+#include <climits>
+
+LargeFileView::LargeFileView(QWidget *parent) :
+    QAbstractScrollArea(parent),
+    data(0),
+    codec(0),
+    searchGeneration(0),
+    searchActive(false),
+    searching(false),
+    findNextUnit(-1),
+    totalMatches(0),
+    currentMatch(-1),
+    currentMatchEnd(-1),
+    scrollPending(false)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    connect(&search, SIGNAL(unitSearched(int,qint64,qint64)), this, SLOT(onUnitSearched(int,qint64,qint64)));
+    connect(&search, SIGNAL(finished(int)), this, SLOT(onSearchFinished(int)));
+}
+
+LargeFileView::~LargeFileView()
+{
+    // Not closeFile(): that emits searchStatusChanged, and by the time the
+    // view is deleted its owner may already be half torn down. Just stop
+    // the threads reading the mapping; QFile unmaps on destruction.
+    search.cancel();
+    index.clear();
+}
+
+bool LargeFileView::openFile(const QString &fileName, QString *errorString)
+{
+    closeFile();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *errorString = file.errorString();
+        return false;
+    }
+    // Mapping an empty file fails, but there is nothing to show anyway.
+    if (file.size() > 0) {
+        data = reinterpret_cast<const char *>(file.map(0, file.size()));
+        if (!data) {
+            *errorString = file.errorString();
+            file.close();
+            return false;
+        }
+    }
+    QByteArray head = QByteArray::fromRawData(data, static_cast<int>(std::min<qint64>(file.size(), 4)));
+    codec = QTextCodec::codecForUtfText(head, QTextCodec::codecForLocale());
+    if (codec->fromUnicode(QStringLiteral("\n")) != "\n") {
+        *errorString = tr("%1 files this large are not supported").arg(QString::fromLatin1(codec->name()));
+        closeFile();
+        return false;
+    }
+    // The callback runs on an indexing thread; hop over to ours.
+    index.build(data, file.size(), [this]() {
+        QMetaObject::invokeMethod(this, "onIndexProgress", Qt::QueuedConnection);
+    });
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+    return true;
+}
+
+void LargeFileView::closeFile()
+{
+    // The search threads read straight from the mapping.
+    clearSearch();
+    index.clear();
+    if (data)
+        file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+    data = 0;
+    file.close();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void LargeFileView::onIndexProgress()
+{
+    updateScrollBars();
+    if (scrollPending) {
+        SearchMatch match = { currentMatch, currentMatchEnd };
+        scrollToMatch(match);
+    }
+    viewport()->update();
+    emit indexProgress();
+}
+
+int LargeFileView::visibleLineCount() const
+{
+    return std::max(1, viewport()->height() / fontMetrics().lineSpacing());
+}
+
+void LargeFileView::updateScrollBars()
+{
+    int visible = visibleLineCount();
+    qint64 maxFirstLine = std::max<qint64>(0, index.lineCount() - visible);
+    verticalScrollBar()->setRange(0, static_cast<int>(std::min<qint64>(maxFirstLine, INT_MAX)));
+    verticalScrollBar()->setPageStep(visible);
+    int charWidth = fontMetrics().averageCharWidth();
+    horizontalScrollBar()->setRange(0, std::max(0, maxDisplayedLineLength * charWidth - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(charWidth);
+}
+
+void LargeFileView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LargeFileView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().base());
+    painter.setPen(palette().text().color());
+
+    QFontMetrics metrics = fontMetrics();
+    int lineSpacing = metrics.lineSpacing();
+    int x = 4 - horizontalScrollBar()->value();
+    qint64 firstLine = verticalScrollBar()->value();
+    qint64 lastLine = std::min<qint64>(index.lineCount(), firstLine + visibleLineCount() + 1);
+    // Only the first visible line goes through the index; the rest are
+    // found by walking forward from it.
+    qint64 begin = 0, end = 0;
+    if (firstLine < lastLine)
+        index.lineRange(firstLine, &begin, &end);
+    for (qint64 line = firstLine; line < lastLine; ++line) {
+        if (line > firstLine)
+            index.nextLineRange(&begin, &end);
+        int length = static_cast<int>(std::min<qint64>(end - begin, maxDisplayedLineLength));
+        QString text = decode(begin, length);
+        int top = static_cast<int>(line - firstLine) * lineSpacing;
+
+        // Highlight the matches overlapping the part of the line shown.
+        QVector<SearchMatch> matches;
+        if (searchActive)
+            matches = search.matchesInLine(begin, end, maxDisplayedLineLength);
+        for (const SearchMatch &match : matches) {
+            qint64 from = std::max<qint64>(0, std::min<qint64>(match.begin - begin, length));
+            qint64 to = std::max<qint64>(0, std::min<qint64>(match.end - begin, length));
+            int left = metrics.width(decode(begin, from));
+            int right = metrics.width(decode(begin, to));
+            QColor color = match.begin == currentMatch ? palette().highlight().color() : QColor(Qt::yellow);
+            painter.fillRect(x + left, top, std::max(right - left, 2), lineSpacing, color);
+        }
+
+        painter.drawText(x, top + metrics.ascent(), text);
+    }
+}
+
+bool LargeFileView::startSearch(const QString &text, bool isRegex, QString *errorString)
+{
+    clearSearch();
+    if (text.isEmpty() || !data)
+        return true;
+    if (isRegex) {
+        QRegularExpression regex(text);
+        if (!regex.isValid()) {
+            *errorString = regex.errorString();
+            return false;
+        }
+        searchGeneration = search.startRegex(data, file.size(), regex, codec);
+    } else {
+        searchGeneration = search.startLiteral(data, file.size(), codec->fromUnicode(text));
+    }
+    unitMatchCounts.assign(search.unitCount(), -1);
+    searchActive = true;
+    searching = true;
+    emit searchStatusChanged();
+    return true;
+}
+
+void LargeFileView::clearSearch()
+{
+    search.cancel();
+    searchActive = false;
+    searching = false;
+    findNextUnit = -1;
+    unitMatchCounts.clear();
+    totalMatches = 0;
+    currentMatch = -1;
+    currentMatchEnd = -1;
+    scrollPending = false;
+    viewport()->update();
+    emit searchStatusChanged();
+}
+
+void LargeFileView::findNext()
+{
+    findNextUnit = -1;
+    if (!searchActive)
+        return;
+    qint64 from = 0;
+    if (currentMatch >= 0) {
+        // Matches don't overlap, so the next one starts after this one.
+        from = currentMatchEnd;
+    } else if (index.lineCount() > 0) {
+        qint64 lineEnd;
+        index.lineRange(verticalScrollBar()->value(), &from, &lineEnd);
+    }
+    if (from >= fileSize())
+        from = 0;
+
+    // Go through the units from the one holding `from`, wrapping around
+    // and ending back in it, and rescan only those that have matches. The
+    // first one is always looked at: a regex match after `from` can be on
+    // a line that started in the unit before. A unit that hasn't been
+    // searched yet may hold the next match, so stop there and come back
+    // once it has.
+    qint64 units = static_cast<qint64>(unitMatchCounts.size());
+    qint64 first = search.unitOf(from);
+    for (qint64 i = 0; i <= units; ++i) {
+        qint64 unit = (first + i) % units;
+        if (unitMatchCounts[unit] < 0) {
+            findNextUnit = unit;
+            return;
+        }
+        if (i > 0 && unitMatchCounts[unit] == 0)
+            continue;
+        qint64 begin = i == 0 ? from : search.unitBegin(unit);
+        qint64 end = i == units ? from : search.unitEnd(unit);
+        SearchMatch match;
+        if (search.findFirst(begin, end, &match)) {
+            scrollToMatch(match);
+            return;
+        }
+    }
+}
+
+void LargeFileView::scrollToMatch(const SearchMatch &match)
+{
+    currentMatch = match.begin;
+    currentMatchEnd = match.end;
+    // A match past the indexed part of the file has no line number yet;
+    // onIndexProgress finishes the job once it does.
+    qint64 line = index.lineForOffset(match.begin);
+    scrollPending = line < 0;
+    if (scrollPending) {
+        viewport()->update();
+        return;
+    }
+    if (line < verticalScrollBar()->value() || line >= verticalScrollBar()->value() + visibleLineCount())
+        verticalScrollBar()->setValue(static_cast<int>(std::min<qint64>(std::max<qint64>(0, line - visibleLineCount() / 2), INT_MAX)));
+
+    qint64 begin, end;
+    index.lineRange(line, &begin, &end);
+    qint64 column = std::min<qint64>(match.begin - begin, maxDisplayedLineLength);
+    int left = fontMetrics().width(decode(begin, column));
+    int scrolled = horizontalScrollBar()->value();
+    if (left < scrolled || left >= scrolled + viewport()->width())
+        horizontalScrollBar()->setValue(left - viewport()->width() / 3);
+    viewport()->update();
+}
+
+void LargeFileView::onUnitSearched(int generation, qint64 unit, qint64 matchCount)
+{
+    if (generation != searchGeneration || !searching)
+        return;
+    unitMatchCounts[unit] = matchCount;
+    totalMatches += matchCount;
+    if (unit == findNextUnit)
+        findNext();
+    if (matchCount > 0)
+        viewport()->update();
+    emit searchStatusChanged();
+}
+
+void LargeFileView::onSearchFinished(int generation)
+{
+    if (generation != searchGeneration || !searching)
+        return;
+    searching = false;
+    emit searchStatusChanged();
+}
+
+// Callers keep length within maxDisplayedLineLength.
+QString LargeFileView::decode(qint64 begin, qint64 length) const
+{
+    return codec->toUnicode(data + begin, static_cast<int>(length));
+}
@@ -0,0 +1,100 @@
+#ifndef LARGEFILEVIEW_H
+#define LARGEFILEVIEW_H
+
+#include "lineindex.h"
+#include "textsearch.h"
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <vector>
+
+class QTextCodec;
+
+// Read-only viewer for files too big for QTextEdit. The file is memory
+// mapped and only the lines currently in the viewport are decoded and
+// drawn, so opening and scrolling cost the same regardless of file size.
+//
+// The codec is picked like the editor's: from the BOM, else the locale's.
+// Lines are split on '\n' bytes, so encodings where that isn't how a
+// newline is stored (UTF-16 and UTF-32) are refused.
+class LargeFileView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit LargeFileView(QWidget *parent = 0);
+    ~LargeFileView();
+
+    // Returns false and sets *errorString if the file can't be shown.
+    bool openFile(const QString &fileName, QString *errorString);
+    void closeFile();
+
+    // The file is indexed in the background after openFile; until that is
+    // done only the lines indexed so far are shown. indexProgress is
+    // emitted whenever more become available.
+    qint64 lineCount() const { return index.lineCount(); }
+    qint64 indexedBytes() const { return index.indexedBytes(); }
+    qint64 fileSize() const { return data ? file.size() : 0; }
+    bool isIndexing() const { return !index.isComplete(); }
+
+    // Searches the whole file in the background; match counts stream in
+    // and searchStatusChanged is emitted as they do. Returns false (and sets
+    // *errorString) if `text` is not a valid regular expression.
+    bool startSearch(const QString &text, bool isRegex, QString *errorString);
+    void clearSearch();
+    // Moves to the first match after the current one (or after the top of
+    // the view), wrapping around. If the search hasn't got that far yet
+    // this happens as soon as it has.
+    void findNext();
+
+    qint64 matchCount() const { return totalMatches; }
+    bool hasSearch() const { return searchActive; }
+    bool isSearching() const { return searching; }
+
+signals:
+    void indexProgress();
+    void searchStatusChanged();
+
+private slots:
+    void onIndexProgress();
+    void onUnitSearched(int generation, qint64 unit, qint64 matchCount);
+    void onSearchFinished(int generation);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+
+private:
+    void updateScrollBars();
+    int visibleLineCount() const;
+    void scrollToMatch(const SearchMatch &match);
+    QString decode(qint64 begin, qint64 length) const;
+
+    // Longest prefix of a single line that gets decoded for display.
+    static const int maxDisplayedLineLength = 4096;
+
+    QFile file;
+    const char *data;
+    QTextCodec *codec;
+    LineIndex index;
+
+    TextSearch search;
+    int searchGeneration;
+    // Set from startSearch until clearSearch; searching only while the
+    // threads are still going.
+    bool searchActive;
+    bool searching;
+    // The unit a findNext is waiting on to be searched, or -1.
+    qint64 findNextUnit;
+    // Matches per search unit, -1 until the unit has been searched. The
+    // matches themselves are looked up again when needed: for the visible
+    // lines when painting, and in the units that have any for findNext.
+    std::vector<qint64> unitMatchCounts;
+    qint64 totalMatches;
+    // The match findNext last moved to, or -1.
+    qint64 currentMatch;
+    qint64 currentMatchEnd;
+    // Set while the current match is waiting to be indexed.
+    bool scrollPending;
+};
+
+#endif // LARGEFILEVIEW_H
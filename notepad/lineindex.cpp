@@ -0,0 +1,172 @@
+#include "lineindex.h"
+#include "bytescan.h"
+#include <algorithm>
+#include <cstring>
+
+LineIndex::LineIndex() :
+    data(0),
+    size(0),
+    readyChunks(0),
+    lines(0)
+{
+}
+
+LineIndex::~LineIndex()
+{
+    clear();
+}
+
+void LineIndex::build(const char *newData, qint64 newSize, std::function<void()> newProgress)
+{
+    clear();
+    if (newSize == 0)
+        return;
+    data = newData;
+    size = newSize;
+    progress = newProgress;
+
+    qint64 chunkCount = ChunkWorkers::chunkCount(size);
+    chunks.assign(chunkCount, Chunk());
+    chunkDone.assign(chunkCount, 0);
+    // Chunks are handed out in order, so the ready prefix grows steadily
+    // from the start of the file.
+    workers.start(chunkCount, [this](qint64 k) {
+        processChunk(k);
+    });
+}
+
+void LineIndex::clear()
+{
+    workers.stop();
+    data = 0;
+    size = 0;
+    progress = nullptr;
+    readyChunks = 0;
+    lines = 0;
+    chunks.clear();
+    chunkDone.clear();
+}
+
+qint64 LineIndex::indexedBytes() const
+{
+    return std::min(readyChunks * chunkSize, size);
+}
+
+void LineIndex::processChunk(qint64 k)
+{
+    indexChunk(k);
+    if (workers.isStopped())
+        return;
+
+    qint64 chunkCount = static_cast<qint64>(chunks.size());
+    bool advanced = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunkDone[k] = 1;
+        qint64 ready = readyChunks;
+        qint64 total = lines;
+        while (ready < chunkCount && chunkDone[ready]) {
+            chunks[ready].firstLine = total;
+            total += chunks[ready].lineCount;
+            ++ready;
+            advanced = true;
+        }
+        readyChunks = ready;
+        lines = total;
+    }
+    if (advanced && progress)
+        progress();
+}
+
+void LineIndex::indexChunk(qint64 k)
+{
+    Chunk &chunk = chunks[k];
+    qint64 begin = k * chunkSize;
+    qint64 end = std::min(begin + chunkSize, size);
+    chunk.lineCount = 0;
+    if (k == 0) {
+        chunk.checkpoints.push_back(0);
+        chunk.lineCount = 1;
+    }
+    // The line after a newline at p starts at p + 1, which is in
+    // (begin, end], so it belongs to this chunk. A trailing newline
+    // doesn't start another line.
+    forEachByte(data + begin, data + end, '\n', [this, &chunk](const char *p) {
+        qint64 start = p + 1 - data;
+        if (start == size)
+            return true;
+        if (chunk.lineCount % checkpointInterval == 0)
+            chunk.checkpoints.push_back(start);
+        ++chunk.lineCount;
+        return !workers.isStopped();
+    });
+}
+
+void LineIndex::lineRange(qint64 line, qint64 *begin, qint64 *end) const
+{
+    Q_ASSERT(line >= 0 && line < lines);
+    // Chunks without any lines share firstLine with their successor; taking
+    // the last chunk with firstLine <= line skips over them.
+    auto it = std::upper_bound(chunks.begin(), chunks.begin() + readyChunks, line, [](qint64 l, const Chunk &chunk) {
+        return l < chunk.firstLine;
+    });
+    const Chunk &chunk = *(it - 1);
+    qint64 local = line - chunk.firstLine;
+    qint64 pos = chunk.checkpoints[local / checkpointInterval];
+    for (qint64 i = 0; i < local % checkpointInterval; ++i) {
+        const void *nl = memchr(data + pos, '\n', size - pos);
+        pos = static_cast<const char *>(nl) - data + 1;
+    }
+    *begin = pos;
+    *end = lineEndAt(pos);
+}
+
+void LineIndex::nextLineRange(qint64 *begin, qint64 *end) const
+{
+    // *end is either the '\n' or a '\r' right before it.
+    const void *nl = memchr(data + *end, '\n', size - *end);
+    Q_ASSERT(nl);
+    *begin = static_cast<const char *>(nl) - data + 1;
+    *end = lineEndAt(*begin);
+}
+
+qint64 LineIndex::lineEndAt(qint64 pos) const
+{
+    const void *nl = memchr(data + pos, '\n', size - pos);
+    qint64 lineEnd = nl ? static_cast<const char *>(nl) - data : size;
+    if (lineEnd > pos && data[lineEnd - 1] == '\r')
+        --lineEnd;
+    return lineEnd;
+}
+
+qint64 LineIndex::lineForOffset(qint64 offset) const
+{
+    Q_ASSERT(offset >= 0 && offset <= size);
+    if (offset >= indexedBytes() && !isComplete())
+        return -1;
+    // The owning chunk is the last one with a line starting at or before
+    // offset. That is normally the chunk offset falls in, or the one before
+    // it when offset is near the start of its chunk; only chunks without
+    // any line starts (very long lines) make this walk further.
+    qint64 k = std::min(offset / chunkSize, readyChunks - 1);
+    const Chunk *owner = 0;
+    for (; k >= 0; --k) {
+        const Chunk &chunk = chunks[k];
+        if (!chunk.checkpoints.empty() && chunk.checkpoints.front() <= offset) {
+            owner = &chunk;
+            break;
+        }
+    }
+    if (!owner)
+        return -1;
+    auto it = std::upper_bound(owner->checkpoints.begin(), owner->checkpoints.end(), offset);
+    qint64 checkpoint = it - owner->checkpoints.begin() - 1;
+    qint64 line = owner->firstLine + checkpoint * checkpointInterval;
+    qint64 pos = owner->checkpoints[checkpoint];
+    forEachByte(data + pos, data + offset, '\n', [&line](const char *) {
+        ++line;
+        return true;
+    });
+    // A trailing newline doesn't start a line of its own.
+    return std::min(line, lines - 1);
+}
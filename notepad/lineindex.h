@@ -0,0 +1,87 @@
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include "chunkworkers.h"
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Maps line numbers to byte ranges of a read-only buffer (normally a mapped
+// file). Only every checkpointInterval'th line start is stored, so the index
+// stays small even for multi-gigabyte files; the remaining lines are found
+// by scanning forward from the nearest checkpoint.
+//
+// Indexing runs on background threads. The buffer is cut into fixed-size
+// chunks that are indexed in parallel; as soon as every chunk up to some
+// point is done, the lines in them become visible through lineCount() and
+// friends, so a view can show the start of a file while the rest is still
+// being read.
+class LineIndex
+{
+public:
+    LineIndex();
+    ~LineIndex();
+
+    // Starts indexing [data, data + size) and returns right away. `progress`
+    // is called from a worker thread whenever more lines become available.
+    // The buffer must stay valid until clear().
+    void build(const char *data, qint64 size, std::function<void()> progress);
+    // Stops any workers and forgets everything.
+    void clear();
+
+    // Only counts the lines indexed so far.
+    qint64 lineCount() const { return lines; }
+    qint64 indexedBytes() const;
+    bool isComplete() const { return readyChunks == static_cast<qint64>(chunks.size()); }
+
+    // Sets [*begin, *end) to the bytes of line `line`, without the line
+    // terminator.
+    void lineRange(qint64 line, qint64 *begin, qint64 *end) const;
+    // Advances [*begin, *end) from one line's range (as returned by
+    // lineRange) to the next one's, without going back to the index.
+    void nextLineRange(qint64 *begin, qint64 *end) const;
+
+    // The line that byte `offset` belongs to, or -1 if that part of the
+    // buffer hasn't been indexed yet.
+    qint64 lineForOffset(qint64 offset) const;
+
+private:
+    static const int checkpointInterval = 64;
+
+    static const qint64 chunkSize = ChunkWorkers::chunkSize;
+
+    // End of the line starting at `pos`, without the line terminator.
+    qint64 lineEndAt(qint64 pos) const;
+    // Runs on a worker: indexes chunk k, then publishes any chunks that
+    // are now part of the ready prefix.
+    void processChunk(qint64 k);
+    void indexChunk(qint64 k);
+
+    // Lines are owned by the chunk their first byte falls in. A chunk is
+    // written by the one worker that indexes it, and only read once it is
+    // part of the ready prefix.
+    struct Chunk {
+        qint64 firstLine;
+        qint64 lineCount;
+        std::vector<qint64> checkpoints;
+    };
+
+    const char *data;
+    qint64 size;
+    std::vector<Chunk> chunks;
+    std::function<void()> progress;
+
+    ChunkWorkers workers;
+    // Guards chunkDone and advancing the ready prefix.
+    std::mutex mutex;
+    std::vector<char> chunkDone;
+    // chunks[0, readyChunks) have their firstLine set; lines is the total
+    // over them. lines is stored last, so whoever sees a line count also
+    // sees the chunks holding those lines.
+    std::atomic<qint64> readyChunks;
+    std::atomic<qint64> lines;
+};
+
+#endif // LINEINDEX_H
@@ -1,19 +1,85 @@
 #include "notepad.h"
 #include "ui_notepad.h"
-#include <QFile>
+#include "fileworker.h"
+#include "largefileview.h"
+#include <QCheckBox>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QLineEdit>
 #include <QMessageBox>
-#include <QTextStream>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QScrollBar>
+#include <QTextCodec>
+#include <QTextDocument>
+#include <QTextEncoder>
+
+// How much text is encoded and handed to the worker per step when saving.
+static const int writeChunkSize = 256 << 10;
 
 Notepad::Notepad(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::Notepad)
+    ui(new Ui::Notepad),
+    largeFileView(new LargeFileView(this)),
+    worker(new FileWorker),
+    progressBar(new QProgressBar),
+    cancelButton(new QPushButton(tr("Cancel"))),
+    ioCancelled(false),
+    saveEncoder(0),
+    findEdit(new QLineEdit),
+    regexCheckBox(new QCheckBox(tr("Regex"))),
+    largeFileSearchStale(true),
+    editorMatchesShown(false)
 {
     ui->setupUi(this);
+    ui->verticalLayout->insertWidget(0, largeFileView);
+    largeFileView->hide();
+
+    progressBar->setRange(0, 1000);
+    progressBar->setTextVisible(false);
+    ui->statusBar->addPermanentWidget(progressBar);
+    ui->statusBar->addPermanentWidget(cancelButton);
+    progressBar->hide();
+    cancelButton->hide();
+    connect(cancelButton, SIGNAL(clicked()), this, SLOT(cancelIo()));
+
+    worker->moveToThread(&ioThread);
+    connect(&ioThread, SIGNAL(finished()), worker, SLOT(deleteLater()));
+    connect(this, SIGNAL(startLoad(QString)), worker, SLOT(startLoad(QString)));
+    connect(this, SIGNAL(readChunk()), worker, SLOT(readChunk()));
+    connect(this, SIGNAL(startSave(QString)), worker, SLOT(startSave(QString)));
+    connect(this, SIGNAL(writeChunk(QByteArray)), worker, SLOT(writeChunk(QByteArray)));
+    connect(this, SIGNAL(finishSave()), worker, SLOT(finishSave()));
+    connect(this, SIGNAL(abortIo()), worker, SLOT(abort()));
+    connect(worker, SIGNAL(chunkRead(QString)), this, SLOT(onChunkRead(QString)));
+    connect(worker, SIGNAL(loadProgress(qint64,qint64)), this, SLOT(onLoadProgress(qint64,qint64)));
+    connect(worker, SIGNAL(loadFinished(bool,QString)), this, SLOT(onLoadFinished(bool,QString)));
+    connect(worker, SIGNAL(chunkWritten()), this, SLOT(onChunkWritten()));
+    connect(worker, SIGNAL(saveFinished(bool,QString)), this, SLOT(onSaveFinished(bool,QString)));
+    ioThread.start();
+
+    findEdit->setPlaceholderText(tr("Find"));
+    ui->mainToolBar->addWidget(findEdit);
+    ui->mainToolBar->addWidget(regexCheckBox);
+    ui->mainToolBar->addAction(ui->actionFindNext);
+    ui->mainToolBar->addAction(ui->actionFindAll);
+    connect(findEdit, SIGNAL(returnPressed()), ui->actionFindNext, SLOT(trigger()));
+    connect(findEdit, SIGNAL(textChanged(QString)), this, SLOT(onSearchQueryChanged()));
+    connect(regexCheckBox, SIGNAL(toggled(bool)), this, SLOT(onSearchQueryChanged()));
+    connect(largeFileView, SIGNAL(searchStatusChanged()), this, SLOT(updateLargeFileStatus()));
+    connect(largeFileView, SIGNAL(indexProgress()), this, SLOT(updateLargeFileStatus()));
+    connect(ui->textEdit->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateEditorMatches()));
+    connect(ui->textEdit->verticalScrollBar(), SIGNAL(rangeChanged(int,int)), this, SLOT(updateEditorMatches()));
+    connect(ui->textEdit, SIGNAL(textChanged()), this, SLOT(updateEditorMatches()));
 }
 
 Notepad::~Notepad()
 {
+    emit abortIo();
+    ioThread.quit();
+    ioThread.wait();
+    delete saveEncoder;
     delete ui;
 }
 
@@ -24,16 +90,67 @@ void Notepad::on_quitButton_clicked()
 
 void Notepad::on_actionOpen_triggered()
 {
-    QString fileName = QFileDialog::getOpenFileName(this, tr("Open file"), QString(), tr("Text files (*.txt);;C++ Files (*.cpp *.h)"));
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open file"), QString(), tr("Text files (*.txt);;C++ Files (*.cpp *.h);;Log files (*.log);;All files (*)"));
     if (fileName.isEmpty())
         return;
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox::critical(this, tr("Error"), tr("Could not open file"));
+
+    // Anything this big would take QTextEdit ages to lay out and several
+    // times its size in memory, so show it read-only straight from a
+    // mapping instead.
+    static const qint64 largeFileThreshold = 32 << 20;
+    if (QFileInfo(fileName).size() >= largeFileThreshold) {
+        QString errorString;
+        if (!largeFileView->openFile(fileName, &errorString)) {
+            QMessageBox::critical(this, tr("Error"), tr("Could not open file: %1").arg(errorString));
+            return;
+        }
+        clearEditorMatches();
+        ui->textEdit->clear();
+        largeFileSearchStale = true;
+        showLargeFileView(true);
+        updateLargeFileStatus();
         return;
     }
-    QTextStream in(&file);
-    ui->textEdit->setText(in.readAll());
+
+    largeFileView->closeFile();
+    showLargeFileView(false);
+    ui->statusBar->clearMessage();
+    clearEditorMatches();
+    ui->textEdit->clear();
+    // The chunks shouldn't end up as individual undo steps.
+    ui->textEdit->document()->setUndoRedoEnabled(false);
+    loadCursor = QTextCursor(ui->textEdit->document());
+    ioCancelled = false;
+    setBusy(true);
+    emit startLoad(fileName);
+}
+
+void Notepad::onChunkRead(const QString &text)
+{
+    if (ioCancelled)
+        return;
+    loadCursor.insertText(text);
+    emit readChunk();
+}
+
+void Notepad::onLoadProgress(qint64 bytesRead, qint64 bytesTotal)
+{
+    setProgress(bytesRead, bytesTotal);
+}
+
+void Notepad::onLoadFinished(bool ok, const QString &errorString)
+{
+    loadCursor = QTextCursor();
+    ui->textEdit->document()->setUndoRedoEnabled(true);
+    setBusy(false);
+    if (!ok) {
+        // Don't leave a partial file behind that looks like the real thing.
+        ui->textEdit->clear();
+        if (!ioCancelled)
+            QMessageBox::critical(this, tr("Error"), tr("Could not open file: %1").arg(errorString));
+        return;
+    }
+    ui->textEdit->moveCursor(QTextCursor::Start);
 }
 
 void Notepad::on_actionSave_triggered()
@@ -41,12 +158,249 @@ void Notepad::on_actionSave_triggered()
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save file"));
     if (fileName.isEmpty())
         return;
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox::critical(this, tr("Error"), tr("Could not open file"));
+    saveBlock = ui->textEdit->document()->begin();
+    saveEncoder = QTextCodec::codecForLocale()->makeEncoder();
+    ioCancelled = false;
+    setBusy(true);
+    emit startSave(fileName);
+}
+
+void Notepad::onChunkWritten()
+{
+    if (ioCancelled)
+        return;
+    // Encode just enough blocks for one chunk. The document is read-only
+    // while saving, so saveBlock stays valid between chunks.
+    QByteArray bytes;
+    while (saveBlock.isValid() && bytes.size() < writeChunkSize) {
+        QTextBlock next = saveBlock.next();
+        // Same conversions as QTextDocument::toPlainText.
+        QString text = saveBlock.text();
+        text.replace(QChar::LineSeparator, QLatin1Char('\n'));
+        text.replace(QChar::Nbsp, QLatin1Char(' '));
+        if (next.isValid())
+            text += QLatin1Char('\n');
+        bytes += saveEncoder->fromUnicode(text);
+        saveBlock = next;
+    }
+    if (bytes.isEmpty()) {
+        emit finishSave();
         return;
     }
-    QTextStream stream(&file);
-    stream << ui->textEdit->toPlainText();
-    stream.flush();
+    QTextDocument *document = ui->textEdit->document();
+    setProgress(saveBlock.isValid() ? saveBlock.position() : document->characterCount(), document->characterCount());
+    emit writeChunk(bytes);
+}
+
+void Notepad::onSaveFinished(bool ok, const QString &errorString)
+{
+    saveBlock = QTextBlock();
+    delete saveEncoder;
+    saveEncoder = 0;
+    setBusy(false);
+    if (!ok && !ioCancelled)
+        QMessageBox::critical(this, tr("Error"), tr("Could not save file: %1").arg(errorString));
+}
+
+void Notepad::cancelIo()
+{
+    // The worker still answers with loadFinished/saveFinished, which is
+    // what actually ends the operation; until then just stop feeding it.
+    ioCancelled = true;
+    cancelButton->setEnabled(false);
+    emit abortIo();
+}
+
+void Notepad::showLargeFileView(bool show)
+{
+    largeFileView->setVisible(show);
+    ui->textEdit->setVisible(!show);
+    ui->actionSave->setEnabled(!show);
+}
+
+void Notepad::setBusy(bool busy)
+{
+    progressBar->setValue(0);
+    progressBar->setVisible(busy);
+    cancelButton->setEnabled(true);
+    cancelButton->setVisible(busy);
+    ui->textEdit->setReadOnly(busy);
+    ui->actionOpen->setEnabled(!busy);
+    ui->actionSave->setEnabled(!busy && largeFileView->isHidden());
+}
+
+void Notepad::setProgress(qint64 done, qint64 total)
+{
+    progressBar->setValue(total > 0 ? static_cast<int>(done * 1000 / total) : 0);
+}
+
+void Notepad::on_actionFind_triggered()
+{
+    findEdit->setFocus();
+    findEdit->selectAll();
+}
+
+void Notepad::on_actionFindNext_triggered()
+{
+    if (findEdit->text().isEmpty())
+        return;
+    if (largeFileView->isHidden()) {
+        findNextInEditor();
+        return;
+    }
+    if (startLargeFileSearch())
+        largeFileView->findNext();
+}
+
+void Notepad::on_actionFindAll_triggered()
+{
+    if (findEdit->text().isEmpty())
+        return;
+    if (largeFileView->isHidden()) {
+        findAllInEditor();
+        return;
+    }
+    // The large file view always finds everything; it only highlights
+    // what is on screen.
+    startLargeFileSearch();
+}
+
+void Notepad::onSearchQueryChanged()
+{
+    largeFileSearchStale = true;
+    clearEditorMatches();
+    // Don't keep searching (and showing matches) for a query that is gone.
+    largeFileView->clearSearch();
+}
+
+void Notepad::updateLargeFileStatus()
+{
+    if (largeFileView->isHidden())
+        return;
+    QString message = tr("%1 lines (read-only)").arg(largeFileView->lineCount());
+    qint64 size = largeFileView->fileSize();
+    if (largeFileView->isIndexing() && size > 0)
+        message += tr(", indexing %1%").arg(largeFileView->indexedBytes() * 100 / size);
+    if (largeFileView->hasSearch()) {
+        message += tr(", %1 matches").arg(largeFileView->matchCount());
+        if (largeFileView->isSearching())
+            message += tr(" (searching...)");
+    }
+    ui->statusBar->showMessage(message);
+}
+
+// Starts a new search in the large file view unless it is already running
+// (or has run) for the current query.
+bool Notepad::startLargeFileSearch()
+{
+    if (!largeFileSearchStale)
+        return true;
+    QString errorString;
+    if (!largeFileView->startSearch(findEdit->text(), regexCheckBox->isChecked(), &errorString)) {
+        ui->statusBar->showMessage(tr("Invalid regular expression: %1").arg(errorString));
+        return false;
+    }
+    largeFileSearchStale = false;
+    return true;
+}
+
+// Documents small enough for the editor are searched with QTextDocument;
+// the raw-buffer search is for files shown in the large file view. Both are
+// case-sensitive, so the same query finds the same things either way.
+void Notepad::findNextInEditor()
+{
+    QTextDocument *document = ui->textEdit->document();
+    QRegularExpression regex(findEdit->text());
+    bool isRegex = regexCheckBox->isChecked();
+    if (isRegex && !regex.isValid()) {
+        ui->statusBar->showMessage(tr("Invalid regular expression: %1").arg(regex.errorString()));
+        return;
+    }
+    QTextCursor from = ui->textEdit->textCursor();
+    for (int pass = 0; pass < 2; ++pass) {
+        QTextCursor found = isRegex ? document->find(regex, from) : document->find(findEdit->text(), from, QTextDocument::FindCaseSensitively);
+        if (!found.isNull()) {
+            ui->textEdit->setTextCursor(found);
+            ui->statusBar->clearMessage();
+            return;
+        }
+        // Wrap around.
+        from = QTextCursor(document);
+    }
+    ui->statusBar->showMessage(tr("Not found"));
+}
+
+// The (position, length) of the matches in one block's text, as
+// QTextDocument::find sees them: case-sensitive, within the block, and not
+// overlapping. Empty regex matches have nothing to highlight and are left
+// out.
+static QVector<QPair<int, int> > findInBlock(const QString &text, const QString &query, const QRegularExpression &regex, bool isRegex)
+{
+    QVector<QPair<int, int> > matches;
+    if (isRegex) {
+        QRegularExpressionMatchIterator it = regex.globalMatch(text);
+        while (it.hasNext()) {
+            QRegularExpressionMatch m = it.next();
+            if (m.capturedLength() > 0)
+                matches.append(qMakePair(m.capturedStart(), m.capturedLength()));
+        }
+    } else {
+        for (int i = text.indexOf(query); i >= 0; i = text.indexOf(query, i + query.size()))
+            matches.append(qMakePair(i, query.size()));
+    }
+    return matches;
+}
+
+// Counts every match but leaves the highlighting to updateEditorMatches:
+// an ExtraSelection per match in a big document would freeze the GUI.
+void Notepad::findAllInEditor()
+{
+    QTextDocument *document = ui->textEdit->document();
+    QString query = findEdit->text();
+    QRegularExpression regex(query);
+    bool isRegex = regexCheckBox->isChecked();
+    if (isRegex && !regex.isValid()) {
+        ui->statusBar->showMessage(tr("Invalid regular expression: %1").arg(regex.errorString()));
+        return;
+    }
+    int count = 0;
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+        count += findInBlock(block.text(), query, regex, isRegex).size();
+    editorMatchesShown = true;
+    updateEditorMatches();
+    ui->statusBar->showMessage(tr("%1 matches").arg(count));
+}
+
+void Notepad::updateEditorMatches()
+{
+    if (!editorMatchesShown)
+        return;
+    QString query = findEdit->text();
+    QRegularExpression regex(query);
+    bool isRegex = regexCheckBox->isChecked();
+    QTextEdit *textEdit = ui->textEdit;
+    QTextBlock first = textEdit->cursorForPosition(QPoint(0, 0)).block();
+    QTextBlock last = textEdit->cursorForPosition(QPoint(textEdit->viewport()->width(), textEdit->viewport()->height())).block();
+
+    QList<QTextEdit::ExtraSelection> selections;
+    QTextEdit::ExtraSelection selection;
+    selection.format.setBackground(Qt::yellow);
+    for (QTextBlock block = first; block.isValid(); block = block.next()) {
+        QVector<QPair<int, int> > matches = findInBlock(block.text(), query, regex, isRegex);
+        for (const QPair<int, int> &match : matches) {
+            selection.cursor = QTextCursor(block);
+            selection.cursor.setPosition(block.position() + match.first);
+            selection.cursor.setPosition(block.position() + match.first + match.second, QTextCursor::KeepAnchor);
+            selections.append(selection);
+        }
+        if (block == last)
+            break;
+    }
+    textEdit->setExtraSelections(selections);
+}
+
+void Notepad::clearEditorMatches()
+{
+    editorMatchesShown = false;
+    ui->textEdit->setExtraSelections(QList<QTextEdit::ExtraSelection>());
 }
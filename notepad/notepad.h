@@ -2,11 +2,22 @@
 #define NOTEPAD_H
 
 #include <QMainWindow>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QThread>
 
 namespace Ui {
 class Notepad;
 }
 
+class FileWorker;
+class LargeFileView;
+class QCheckBox;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QTextEncoder;
+
 class Notepad : public QMainWindow
 {
     Q_OBJECT
@@ -22,8 +33,60 @@ private slots:
 
     void on_actionSave_triggered();
 
+    void onChunkRead(const QString &text);
+    void onLoadProgress(qint64 bytesRead, qint64 bytesTotal);
+    void onLoadFinished(bool ok, const QString &errorString);
+    void onChunkWritten();
+    void onSaveFinished(bool ok, const QString &errorString);
+    void cancelIo();
+
+    void on_actionFind_triggered();
+    void on_actionFindNext_triggered();
+    void on_actionFindAll_triggered();
+    void onSearchQueryChanged();
+    void updateLargeFileStatus();
+    void updateEditorMatches();
+
+signals:
+    // Requests for the FileWorker on ioThread.
+    void startLoad(const QString &fileName);
+    void readChunk();
+    void startSave(const QString &fileName);
+    void writeChunk(const QByteArray &bytes);
+    void finishSave();
+    void abortIo();
+
 private:
+    void showLargeFileView(bool show);
+    void setBusy(bool busy);
+    void setProgress(qint64 done, qint64 total);
+    bool startLargeFileSearch();
+    void findNextInEditor();
+    void findAllInEditor();
+    void clearEditorMatches();
+
     Ui::Notepad *ui;
+    LargeFileView *largeFileView;
+
+    QThread ioThread;
+    FileWorker *worker;
+    QProgressBar *progressBar;
+    QPushButton *cancelButton;
+    bool ioCancelled;
+
+    // Where the next loaded chunk goes.
+    QTextCursor loadCursor;
+    // The next block to be encoded and handed to the worker when saving.
+    QTextBlock saveBlock;
+    QTextEncoder *saveEncoder;
+
+    QLineEdit *findEdit;
+    QCheckBox *regexCheckBox;
+    // Whether the query changed since largeFileView last started searching.
+    bool largeFileSearchStale;
+    // Whether Find All is highlighting matches in the editor. Only the
+    // visible blocks get highlighted, again on every scroll.
+    bool editorMatchesShown;
 };
 
 #endif // NOTEPAD_H
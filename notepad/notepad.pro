@@ -12,9 +12,22 @@ TARGET = notepad
 TEMPLATE = app
 
 
+QMAKE_CXXFLAGS += -std=c++11
+
 SOURCES += main.cpp\
-        notepad.cpp
+        notepad.cpp\
+        chunkworkers.cpp\
+        fileworker.cpp\
+        lineindex.cpp\
+        largefileview.cpp\
+        textsearch.cpp
 
-HEADERS  += notepad.h
+HEADERS  += notepad.h\
+        bytescan.h\
+        chunkworkers.h\
+        fileworker.h\
+        lineindex.h\
+        largefileview.h\
+        textsearch.h
 
 FORMS    += notepad.ui
@@ -0,0 +1,222 @@
+#include "textsearch.h"
+#include "bytescan.h"
+#include <QTextCodec>
+#include <algorithm>
+#include <cstring>
+
+// Also the most that finding the next match has to rescan.
+static const qint64 unitSize = ChunkWorkers::chunkSize;
+
+// Regex search decodes and matches no more than this much of each line,
+// so a file without newlines doesn't turn into one giant QString.
+static const qint64 maxRegexLineLength = 1 << 20;
+
+TextSearch::TextSearch(QObject *parent) :
+    QObject(parent),
+    data(0),
+    size(0),
+    codec(0),
+    isRegex(false),
+    generation(0)
+{
+}
+
+TextSearch::~TextSearch()
+{
+    cancel();
+}
+
+int TextSearch::startLiteral(const char *newData, qint64 newSize, const QByteArray &newNeedle)
+{
+    cancel();
+    needle = newNeedle;
+    isRegex = false;
+    start(newData, newSize);
+    return generation;
+}
+
+int TextSearch::startRegex(const char *newData, qint64 newSize, const QRegularExpression &newRegex, QTextCodec *newCodec)
+{
+    cancel();
+    regex = newRegex;
+    codec = newCodec;
+    regex.optimize();
+    isRegex = true;
+    start(newData, newSize);
+    return generation;
+}
+
+void TextSearch::cancel()
+{
+    workers.stop();
+}
+
+qint64 TextSearch::unitCount() const
+{
+    return ChunkWorkers::chunkCount(size);
+}
+
+qint64 TextSearch::unitOf(qint64 offset) const
+{
+    return offset / unitSize;
+}
+
+qint64 TextSearch::unitBegin(qint64 unit) const
+{
+    return unit * unitSize;
+}
+
+qint64 TextSearch::unitEnd(qint64 unit) const
+{
+    return std::min(unitBegin(unit) + unitSize, size);
+}
+
+void TextSearch::start(const char *newData, qint64 newSize)
+{
+    data = newData;
+    size = newSize;
+    ++generation;
+    int searchGeneration = generation;
+    workers.start(unitCount(), [this](qint64 unit) {
+        searchUnit(unit);
+    }, [this, searchGeneration]() {
+        emit finished(searchGeneration);
+    });
+}
+
+template <typename Fn>
+void TextSearch::forEachMatch(qint64 begin, qint64 end, Fn fn) const
+{
+    if (isRegex)
+        forEachRegexMatch(begin, end, fn);
+    else
+        forEachLiteralMatch(begin, end, fn);
+}
+
+template <typename Fn>
+void TextSearch::forEachLiteralMatch(qint64 begin, qint64 end, Fn fn) const
+{
+    qint64 length = needle.size();
+    if (length == 0 || length > size)
+        return;
+    const char *first = data + begin;
+    const char *last = data + std::min(end, size - length + 1);
+    if (first >= last)
+        return;
+    const char *n = needle.constData();
+    // Like find-next would, don't report matches that overlap the previous
+    // one.
+    const char *resume = first;
+    forEachByte(first, last, n[0], [this, n, length, &resume, &fn](const char *p) {
+        if (p >= resume && memcmp(p + 1, n + 1, length - 1) == 0) {
+            SearchMatch match = { p - data, p - data + length };
+            resume = p + length;
+            if (!fn(match))
+                return false;
+        }
+        return !workers.isStopped();
+    });
+}
+
+template <typename Fn>
+void TextSearch::forEachRegexMatch(qint64 begin, qint64 end, Fn fn) const
+{
+    // None of the scans below go further than the lines starting in
+    // [begin, end) need, so one huge line isn't rescanned for every unit.
+    qint64 lineBegin = begin;
+    if (begin > 0) {
+        const void *nl = memchr(data + begin - 1, '\n', end - begin + 1);
+        if (!nl)
+            return;
+        lineBegin = static_cast<const char *>(nl) - data + 1;
+    }
+    while (lineBegin < end && !workers.isStopped()) {
+        qint64 limit = std::min(size, std::max(end, lineBegin + maxRegexLineLength + 1));
+        const void *nl = memchr(data + lineBegin, '\n', limit - lineBegin);
+        qint64 lineEnd = nl ? static_cast<const char *>(nl) - data : limit;
+        qint64 nextLine = lineEnd + 1;
+        if (lineEnd > lineBegin && data[lineEnd - 1] == '\r')
+            --lineEnd;
+        if (!forEachRegexMatchInLine(lineBegin, lineEnd, maxRegexLineLength, fn))
+            return;
+        lineBegin = nextLine;
+    }
+}
+
+template <typename Fn>
+bool TextSearch::forEachRegexMatchInLine(qint64 lineBegin, qint64 lineEnd, qint64 maxLength, Fn fn) const
+{
+    // Don't cut a UTF-8 sequence in half. In a single-byte encoding this
+    // just stops a little early.
+    if (lineEnd - lineBegin > maxLength) {
+        lineEnd = lineBegin + maxLength;
+        while (lineEnd > lineBegin && (data[lineEnd] & 0xc0) == 0x80)
+            --lineEnd;
+    }
+    QString line = codec->toUnicode(data + lineBegin, static_cast<int>(lineEnd - lineBegin));
+    QRegularExpressionMatchIterator it = regex.globalMatch(line);
+    while (it.hasNext()) {
+        QRegularExpressionMatch m = it.next();
+        if (m.capturedLength() == 0)
+            continue;
+        // Back to byte offsets; only paid for lines that match.
+        qint64 matchBegin = lineBegin + codec->fromUnicode(line.left(m.capturedStart())).size();
+        SearchMatch match = { matchBegin, matchBegin + codec->fromUnicode(m.captured()).size() };
+        if (!fn(match))
+            return false;
+    }
+    return true;
+}
+
+void TextSearch::searchUnit(qint64 unit)
+{
+    qint64 count = 0;
+    forEachMatch(unitBegin(unit), unitEnd(unit), [&count](const SearchMatch &) {
+        ++count;
+        return true;
+    });
+    if (!workers.isStopped())
+        emit unitSearched(generation, unit, count);
+}
+
+QVector<SearchMatch> TextSearch::matchesInLine(qint64 lineBegin, qint64 lineEnd, qint64 maxLength) const
+{
+    QVector<SearchMatch> matches;
+    auto collect = [&matches](const SearchMatch &match) {
+        matches.append(match);
+        return true;
+    };
+    if (isRegex) {
+        forEachRegexMatchInLine(lineBegin, lineEnd, maxLength, collect);
+    } else {
+        // Include matches that start on an earlier line and run into this
+        // one.
+        qint64 begin = std::max<qint64>(0, lineBegin - needle.size() + 1);
+        forEachLiteralMatch(begin, std::min(lineEnd, lineBegin + maxLength), [&](const SearchMatch &match) {
+            return match.end <= lineBegin || collect(match);
+        });
+    }
+    return matches;
+}
+
+bool TextSearch::findFirst(qint64 from, qint64 end, SearchMatch *match) const
+{
+    bool found = false;
+    auto first = [from, match, &found](const SearchMatch &m) {
+        if (m.begin < from)
+            return true;
+        *match = m;
+        found = true;
+        return false;
+    };
+    if (isRegex) {
+        // Matches after `from` can be on the line it is in.
+        qint64 lineBegin = from;
+        while (lineBegin > 0 && data[lineBegin - 1] != '\n')
+            --lineBegin;
+        forEachRegexMatch(lineBegin, end, first);
+    } else {
+        forEachLiteralMatch(from, end, first);
+    }
+    return found;
+}
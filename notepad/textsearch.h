@@ -0,0 +1,97 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include "chunkworkers.h"
+#include <QObject>
+#include <QRegularExpression>
+#include <QVector>
+
+class QTextCodec;
+
+// A match as a byte range [begin, end) of the searched buffer.
+struct SearchMatch {
+    qint64 begin;
+    qint64 end;
+};
+
+// Searches a read-only buffer (normally a mapped file) on all cores. The
+// buffer is cut into the same chunks as LineIndex uses, called units here,
+// which ChunkWorkers hands out to the threads. For each unit only the
+// number of matches is reported, as soon as it is known, so results stream
+// in while the search runs and nothing kept around grows with the number
+// of matches. The matches themselves
+// are found again on demand, for the part of the buffer that is needed
+// (the visible lines, or the unit that holds the next match).
+//
+// Literal search scans for the needle's first byte with forEachByte and
+// verifies candidates with memcmp. Regex search is line based, like grep:
+// every line is decoded and matched on its own, and its matches
+// count towards the unit the line starts in. Only the first MiB of a line
+// is looked at.
+class TextSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TextSearch(QObject *parent = 0);
+    ~TextSearch();
+
+    // Both cancel any search in progress and return the generation number
+    // that the signals of the new search will carry. The buffer must stay
+    // valid until the search is cancelled.
+    int startLiteral(const char *data, qint64 size, const QByteArray &needle);
+    // Lines are decoded with `codec`, which must store '\n' as that byte.
+    int startRegex(const char *data, qint64 size, const QRegularExpression &regex, QTextCodec *codec);
+
+    // Blocks until the worker threads have stopped. Signals from the
+    // cancelled search may still be queued; compare their generation.
+    void cancel();
+
+    qint64 unitCount() const;
+    qint64 unitOf(qint64 offset) const;
+    qint64 unitBegin(qint64 unit) const;
+    qint64 unitEnd(qint64 unit) const;
+
+    // These run on the calling thread, for the current search, and are
+    // safe to use while the workers are still going. A cancelled search
+    // finds nothing.
+    // The matches on the line [lineBegin, lineEnd), looking at no more
+    // than its first maxLength bytes.
+    QVector<SearchMatch> matchesInLine(qint64 lineBegin, qint64 lineEnd, qint64 maxLength) const;
+    // The first match starting at or after `from` whose unit-counting
+    // position (the match itself, or its line for a regex) is before end.
+    bool findFirst(qint64 from, qint64 end, SearchMatch *match) const;
+
+signals:
+    // Emitted from the worker threads.
+    void unitSearched(int generation, qint64 unit, qint64 matchCount);
+    void finished(int generation);
+
+private:
+    void start(const char *data, qint64 size);
+    void searchUnit(qint64 unit);
+    // Call fn(match) for the literal matches starting in [begin, end), or
+    // the regex matches on lines starting there, until fn returns false.
+    template <typename Fn>
+    void forEachLiteralMatch(qint64 begin, qint64 end, Fn fn) const;
+    template <typename Fn>
+    void forEachRegexMatch(qint64 begin, qint64 end, Fn fn) const;
+    // The regex matches in the first maxLength bytes of one line, given
+    // without its terminator; false if fn asked to stop.
+    template <typename Fn>
+    bool forEachRegexMatchInLine(qint64 lineBegin, qint64 lineEnd, qint64 maxLength, Fn fn) const;
+    template <typename Fn>
+    void forEachMatch(qint64 begin, qint64 end, Fn fn) const;
+
+    const char *data;
+    qint64 size;
+    QByteArray needle;
+    QRegularExpression regex;
+    QTextCodec *codec;
+    bool isRegex;
+    int generation;
+
+    ChunkWorkers workers;
+};
+
+#endif // TEXTSEARCH_H
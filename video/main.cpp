@@ -8,6 +8,9 @@
 #include <QPixmap>
 #include <QImage>
 #include <QLabel>
+#include <QRect>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <vector>
 
@@ -181,17 +184,29 @@ public:
     glBindBuffer(GL_ARRAY_BUFFER, ViewFillingSquareVertexBuffer.getName());
     glBufferData(GL_ARRAY_BUFFER, sizeof(Vertices), &Vertices, GL_STATIC_DRAW);
   }
-  void convertFrame(const YUV4MPEG2 &Y4M, int WhichFrame) {
+  // Converts only the sub-rectangle `Region` (in luma samples) of the
+  // frame. The RGB texture ends up being exactly `Region.size()`, so the
+  // cost here scales with what is on screen and not with the source
+  // resolution. `Region` must have even coordinates and dimensions so that
+  // it maps exactly onto the 4:2:0 chroma planes.
+  void convertFrame(const YUV4MPEG2 &Y4M, int WhichFrame, const QRect &Region) {
     glBindFramebuffer(GL_FRAMEBUFFER, RGBConvertedFramebuffer.getName());
 
-    glBindTexture(GL_TEXTURE_2D, RGBTexture.getName());
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, Y4M.Width, Y4M.Height, 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, nullptr);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           RGBTexture.getName(), 0);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-      qDebug() << "Framebuffer not complete!";
+    // Only (re)allocate when the region changes size; for a steady zoom
+    // level we just overwrite the existing storage.
+    bool Reallocate = Region.size() != AllocatedSize;
+    AllocatedSize = Region.size();
+    if (Reallocate) {
+      glBindTexture(GL_TEXTURE_2D, RGBTexture.getName());
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, Region.width(), Region.height(),
+                   0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_TEXTURE_2D, RGBTexture.getName(), 0);
+      if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "Framebuffer not complete!";
+      }
     }
+    glViewport(0, 0, Region.width(), Region.height());
     glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -199,17 +214,15 @@ public:
     // For starters, see `od_img_plane` and `od_img` in the daala source.
     // Especially I like how it handles "decimation".
     const YUV4MPEG2::Frame &Frame = Y4M.Frames[WhichFrame];
-    glBindTexture(GL_TEXTURE_2D, LumaTexture.getName());
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, Y4M.Width, Y4M.Height, 0,
-                 GL_LUMINANCE, GL_UNSIGNED_BYTE, Frame.Y);
+    uploadPlaneRegion(LumaTexture, Frame.Y, Y4M.Width, Region, Reallocate);
     // XXX: Hardcoded division by 2 for 4:2:0. Breaks encapsulation of
     // YUV4MPEG2 class.
-    glBindTexture(GL_TEXTURE_2D, CbTexture.getName());
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, Y4M.Width / 2, Y4M.Height / 2,
-                 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, Frame.Cb);
-    glBindTexture(GL_TEXTURE_2D, CrTexture.getName());
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, Y4M.Width / 2, Y4M.Height / 2,
-                 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, Frame.Cr);
+    QRect ChromaRegion(Region.x() / 2, Region.y() / 2, Region.width() / 2,
+                       Region.height() / 2);
+    uploadPlaneRegion(CbTexture, Frame.Cb, Y4M.Width / 2, ChromaRegion,
+                      Reallocate);
+    uploadPlaneRegion(CrTexture, Frame.Cr, Y4M.Width / 2, ChromaRegion,
+                      Reallocate);
 
     // TODO: write an alternative version of this with the "nice" API
     // provided by QOpenGLShaderProgram, e.g.
@@ -248,6 +261,35 @@ public:
     Program.release();
   }
   GLuint getRGBTextureName() { return RGBTexture.getName(); }
+
+private:
+  // Uploads `Region` of a single-byte-per-sample plane that is `PlaneWidth`
+  // samples wide, reading straight out of the mapped file. The unpack
+  // parameters let GL do the striding, so nothing outside of `Region` is
+  // touched and no intermediate copy is made.
+  void uploadPlaneRegion(OpenGLTexture &Texture, const uchar *Plane,
+                         int PlaneWidth, const QRect &Region,
+                         bool Reallocate) {
+    glBindTexture(GL_TEXTURE_2D, Texture.getName());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, PlaneWidth);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, Region.x());
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, Region.y());
+    if (Reallocate)
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, Region.width(),
+                   Region.height(), 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, Plane);
+    else
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Region.width(), Region.height(),
+                      GL_LUMINANCE, GL_UNSIGNED_BYTE, Plane);
+    // Put the defaults back so that other uploads aren't affected.
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
+
+  // Size of the storage currently backing the textures above.
+  QSize AllocatedSize;
 };
 
 const char YUVToRGBConverter::VertexShaderSource[] = R"(
@@ -296,16 +338,61 @@ public:
     else if (K == Qt::Key_H)
       --TopVertexLeftRight;
     else if (K == Qt::Key_Left)
-      ++LeftRight;
+      LeftRight -= panStep(Y4M.Width);
     else if (K == Qt::Key_Right)
-      --LeftRight;
+      LeftRight += panStep(Y4M.Width);
     else if (K == Qt::Key_Up)
-      ++UpDown;
+      UpDown -= panStep(Y4M.Height);
     else if (K == Qt::Key_Down)
-      --UpDown;
+      UpDown += panStep(Y4M.Height);
+    else if (K == Qt::Key_Plus || K == Qt::Key_Equal)
+      Zoom = Zoom < MaxZoom ? Zoom + 1 : Zoom;
+    else if (K == Qt::Key_Minus)
+      Zoom = Zoom > 0 ? Zoom - 1 : Zoom;
+    else if (K == Qt::Key_0)
+      Zoom = UpDown = LeftRight = 0;
     render();
   }
 
+  // Pan by an eighth of what is currently visible, so that panning feels
+  // the same at every zoom level.
+  int panStep(int SourceExtent) const {
+    return std::max(1, (SourceExtent >> Zoom) / 8);
+  }
+
+  // The part of the source frame (in luma samples, y down) that is on
+  // screen. `LeftRight` and `UpDown` are the offset of its center from the
+  // center of the frame; they get clamped here so we never look off the
+  // edge of the frame.
+  QRectF visibleRect() {
+    qreal W = static_cast<qreal>(Y4M.Width) / (1 << Zoom);
+    qreal H = static_cast<qreal>(Y4M.Height) / (1 << Zoom);
+    int MaxLeftRight = static_cast<int>((Y4M.Width - W) / 2);
+    int MaxUpDown = static_cast<int>((Y4M.Height - H) / 2);
+    LeftRight = std::max(-MaxLeftRight, std::min(LeftRight, MaxLeftRight));
+    UpDown = std::max(-MaxUpDown, std::min(UpDown, MaxUpDown));
+    qreal CenterX = Y4M.Width / 2.0 + LeftRight;
+    qreal CenterY = Y4M.Height / 2.0 + UpDown;
+    return QRectF(CenterX - W / 2, CenterY - H / 2, W, H);
+  }
+
+  // The region that actually gets uploaded and converted: `Visible` grown
+  // by a small margin (so that filtering at the edges of the view has real
+  // texels to read) and snapped outward to even coordinates so that it
+  // lines up with the 4:2:0 chroma planes.
+  QRect uploadRegionFor(const QRectF &Visible) const {
+    static const int Margin = 16;
+    int X0 = static_cast<int>(std::floor(Visible.left())) - Margin;
+    int Y0 = static_cast<int>(std::floor(Visible.top())) - Margin;
+    int X1 = static_cast<int>(std::ceil(Visible.right())) + Margin;
+    int Y1 = static_cast<int>(std::ceil(Visible.bottom())) + Margin;
+    X0 = std::max(0, X0) & ~1;
+    Y0 = std::max(0, Y0) & ~1;
+    X1 = std::min(Y4M.Width, (X1 + 1) & ~1);
+    Y1 = std::min(Y4M.Height, (Y1 + 1) & ~1);
+    return QRect(X0, Y0, X1 - X0, Y1 - Y0);
+  }
+
   void initialize() override {
     // initializeGLFunctions();
     Program = new QOpenGLShaderProgram(this);
@@ -325,7 +412,9 @@ public:
     return Ret;
   }
   void render() override {
-    Converter.convertFrame(Y4M, FrameNum % Y4M.Frames.size());
+    QRectF Visible = visibleRect();
+    QRect Region = uploadRegionFor(Visible);
+    Converter.convertFrame(Y4M, FrameNum % Y4M.Frames.size(), Region);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, width(), height());
 
@@ -380,11 +469,18 @@ public:
 
     Program->setUniformValue("matrix", M);
 
-    Vertex Vertices[] = {               //
-        {{-1.0f, -1.0f}, {0.0f, 0.0f}}, // Bottom left.
-        {{-1.0f, 1.0f}, {0.0f, 1.0f}},  // Top left.
-        {{1.0f, -1.0f}, {1.0f, 0.0f}},  // Bottom right.
-        {{1.0f, 1.0f}, {1.0f, 1.0f}},   // Top right.
+    // The RGB texture only covers `Region`, so pick out the visible part
+    // of it. The converter already flipped the image, so the top of the
+    // region is at T=1.
+    GLfloat S0 = (Visible.left() - Region.x()) / Region.width();
+    GLfloat S1 = (Visible.right() - Region.x()) / Region.width();
+    GLfloat T0 = 1.0f - (Visible.bottom() - Region.y()) / Region.height();
+    GLfloat T1 = 1.0f - (Visible.top() - Region.y()) / Region.height();
+    Vertex Vertices[] = {           //
+        {{-1.0f, -1.0f}, {S0, T0}}, // Bottom left.
+        {{-1.0f, 1.0f}, {S0, T1}},  // Top left.
+        {{1.0f, -1.0f}, {S1, T0}},  // Bottom right.
+        {{1.0f, 1.0f}, {S1, T1}},   // Top right.
     };
 
     GLuint VBOID;
@@ -414,8 +510,12 @@ public:
   }
 
 private:
+  // Pan offset of the view center from the frame center, in luma samples.
   int UpDown = 0;
   int LeftRight = 0;
+  // The view shows 1/2^Zoom of the frame in each dimension.
+  int Zoom = 0;
+  static const int MaxZoom = 6;
   int TopVertexUpDown = 0;
   int TopVertexLeftRight = 0;
 